@@ -0,0 +1,434 @@
+#!/usr/bin/env python3
+# SPDX-License-Identifier: MIT
+#
+# Register accessor generator for the rules-ng XML database in src/.
+#
+# Emits one Seo module per XML file:
+#   - REG_<DOMAIN>_<NAME> offsets, array registers as const fns of their index;
+#     arrays placed by doffsets take the instance's runtime base instead
+#   - enum values as u32 consts, <enum>_name(value) for decoders
+#   - bitfield MASK/SHIFT consts, const fn packers and _get unpackers
+#   - <module>::reg_name(offset), a perfect-hash table of offset -> name for
+#     register dumps; registers under a doffsets array have no fixed offset and
+#     are left out
+#
+# Only the file's own definitions are emitted; imports are parsed to resolve
+# bitset and enum types. Where variants define the same name twice the first
+# definition wins, the rest are counted in the file header.
+#
+# usage: gen_regdb.py [-o OUTDIR] [-q] file.xml...
+
+import argparse
+import hashlib
+import os
+import re
+import sys
+import xml.etree.ElementTree as ET
+
+NS = "{http://nouveau.freedesktop.org/}"
+
+# Expanded array elements per register in the name table
+MAX_DUMP_ELEMENTS = 64
+
+# Name table load factor, slots = keys * 5 / 4
+LOAD_NUM, LOAD_DEN = 5, 4
+
+
+def tag(e):
+    return e.tag[len(NS):] if e.tag.startswith(NS) else e.tag
+
+
+def num(s):
+    s = s.strip()
+    return int(s, 0)
+
+
+def ident(s):
+    return re.sub(r"[^A-Za-z0-9_]", "_", s)
+
+
+def mix32(x):
+    # murmur3 finalizer, mirrored by the emitted `mix`
+    x &= 0xFFFFFFFF
+    x ^= x >> 16
+    x = (x * 0x85EBCA6B) & 0xFFFFFFFF
+    x ^= x >> 13
+    x = (x * 0xC2B2AE35) & 0xFFFFFFFF
+    x ^= x >> 16
+    return x
+
+
+class Field:
+    def __init__(self, e):
+        self.name = ident(e.get("name"))
+        if e.get("pos") is not None:
+            self.low = self.high = num(e.get("pos"))
+        else:
+            self.low = num(e.get("low"))
+            self.high = num(e.get("high"))
+        self.type = e.get("type") or ("boolean" if self.low == self.high and e.get("pos") else "uint")
+        self.shr = num(e.get("shr") or "0")
+    
+    @property
+    def mask(self):
+        return ((1 << (self.high - self.low + 1)) - 1) << self.low
+
+
+class Database:
+    def __init__(self, srcdir):
+        self.srcdir = srcdir
+        self.files = {}
+        # Every XML parsed, imports included, for the depfile
+        self.paths = []
+        self.bitsets = {}
+        self.enums = {}
+    
+    def load(self, path):
+        base = os.path.basename(path)
+        if base in self.files:
+            return self.files[base]
+        root = ET.parse(path).getroot()
+        self.files[base] = root
+        self.paths.append(path)
+        for e in root:
+            t = tag(e)
+            if t == "import":
+                dep = os.path.join(self.srcdir, os.path.basename(e.get("file")))
+                if os.path.exists(dep):
+                    self.load(dep)
+        for e in root.iter():
+            t = tag(e)
+            if t == "bitset":
+                self.bitsets.setdefault(e.get("name"), e)
+            elif t == "enum":
+                self.enums.setdefault(e.get("name"), e)
+        return root
+
+
+class Emitter:
+    def __init__(self, db, root, module):
+        self.db = db
+        self.root = root
+        self.module = module
+        self.out = []
+        self.names = set()
+        self.skipped = 0
+        # (offset, name) for the dump table
+        self.dump = {}
+    
+    def line(self, s=""):
+        self.out.append(s)
+    
+    def claim(self, name):
+        if name in self.names:
+            self.skipped += 1
+            return False
+        self.names.add(name)
+        return True
+    
+    # Enum values: bare u32 consts, auto-incremented when value= is missing
+    def enum(self, e):
+        if e.get("name") == "chip" and e.get("bare") == "yes" and self.module != "adreno_common":
+            return
+        body = []
+        names = {}
+        next_value = 0
+        for v in e:
+            if tag(v) != "value":
+                continue
+            value = num(v.get("value")) if v.get("value") is not None else next_value
+            next_value = value + 1
+            name = ident(v.get("name"))
+            names.setdefault(value, name)
+            if self.claim(name):
+                body.append("    pub const %s: u32 = 0x%x;" % (name, value))
+        if body:
+            self.line("    // enum %s" % e.get("name"))
+            self.out.extend(body)
+            self.enum_names(ident(e.get("name")).lower(), names)
+            self.line()
+    
+    # Value -> name for decoders and validators, first variant wins
+    def enum_names(self, enum, names):
+        if not self.claim(enum + "_name"):
+            return
+        self.line("    pub fn %s_name(v: u32) -> Option<&'static str> {" % enum)
+        self.line("        match v {")
+        for value in sorted(names):
+            self.line('            0x%x => Some("%s"),' % (value, names[value]))
+        self.line("            _ => None")
+        self.line("        }")
+        self.line("    }")
+    
+    def fields(self, prefix, e):
+        for f in e:
+            if tag(f) == "bitfield":
+                self.field(prefix, Field(f))
+    
+    def field(self, prefix, f):
+        name = "%s_%s" % (prefix, f.name)
+        if not self.claim(name):
+            return
+        fn = name.lower()
+        self.line("    pub const %s__MASK: u32 = 0x%08x;" % (name, f.mask & 0xFFFFFFFF))
+        self.line("    pub const %s__SHIFT: u32 = %d;" % (name, f.low))
+        if f.type == "boolean":
+            self.line("    #[inline(always)] pub const fn %s(v: bool) -> u32 { if v { %s__MASK } else { 0 } }"
+                      % (fn, name))
+            self.line("    #[inline(always)] pub const fn %s_get(r: u32) -> bool { r & %s__MASK != 0 }"
+                      % (fn, name))
+            return
+        # Signed and fixed-point fields are packed from their raw encoding
+        shr = " >> %d" % f.shr if f.shr else ""
+        shl = " << %d" % f.shr if f.shr else ""
+        self.line("    #[inline(always)] pub const fn %s(v: u32) -> u32 { ((v%s) << %s__SHIFT) & %s__MASK }"
+                  % (fn, shr, name, name))
+        self.line("    #[inline(always)] pub const fn %s_get(r: u32) -> u32 { ((r & %s__MASK) >> %s__SHIFT)%s }"
+                  % (fn, name, name, shl))
+    
+    # Register with its bitfields; `arrays` are the enclosing arrays, outermost first
+    def reg(self, domain, path, e, arrays, width):
+        reg_name = "_".join([domain] + path + [ident(e.get("name"))])
+        if not self.claim("REG_" + reg_name):
+            return
+        offset = num(e.get("offset"))
+        if arrays:
+            params = ", ".join(a.param(n) + ": u32" for n, a in enumerate(arrays))
+            terms = [a.term(n) for n, a in enumerate(arrays)]
+            if offset:
+                terms.append("0x%x" % offset)
+            self.line("    #[inline(always)] pub const fn reg_%s(%s) -> u32 { %s }"
+                      % (reg_name.lower(), params, " + ".join(terms)))
+        else:
+            self.line("    pub const REG_%s: u32 = 0x%08x;" % (reg_name, offset))
+        self.collect(reg_name, offset, arrays, width)
+        
+        inline = [f for f in e if tag(f) == "bitfield"]
+        if inline:
+            self.fields(reg_name, e)
+        bitset = self.db.bitsets.get(e.get("type") or "")
+        if bitset is not None and bitset.get("inline") == "yes":
+            self.fields(reg_name, bitset)
+    
+    # Expand array elements for the dump table, bounded per register
+    def collect(self, name, offset, arrays, width):
+        # Base only known at runtime; a stride guess would collide with real registers
+        if any(a.runtime for a in arrays):
+            return
+        elems = [(offset, name)]
+        for a in arrays:
+            expanded = []
+            for base, label in elems:
+                for i in range(min(a.length, MAX_DUMP_ELEMENTS)):
+                    expanded.append((base + a.base(i), "%s[%d]" % (label, i)))
+            elems = expanded[:MAX_DUMP_ELEMENTS]
+        for off, label in elems:
+            self.dump.setdefault(off, label)
+            if width == 64:
+                self.dump.setdefault(off + 1, label + "_HI")
+    
+    def walk(self, domain, path, e, arrays):
+        for c in e:
+            t = tag(c)
+            if t in ("reg32", "reg64"):
+                self.reg(domain, path, c, arrays, 64 if t == "reg64" else 32)
+            elif t == "array":
+                a = Array(c)
+                name = [ident(c.get("name"))] if c.get("name") else []
+                if a.runtime:
+                    self.line("    // %s: per-SoC placement, pass the instance base (%s)"
+                              % ("_".join([domain] + path + name), a.runtime))
+                self.walk(domain, path + name, c, arrays + [a])
+            elif t == "stripe":
+                prefix = [ident(c.get("prefix"))] if c.get("prefix") else []
+                self.walk(domain, path + prefix, c, arrays)
+            elif t == "bitset":
+                self.bitset(c)
+            elif t == "enum":
+                self.enum(c)
+    
+    def bitset(self, e):
+        if e.get("inline") == "yes":
+            return
+        self.line("    // bitset %s" % e.get("name"))
+        self.fields(ident(e.get("name")).upper(), e)
+        self.line()
+    
+    def domain(self, e):
+        name = ident(e.get("name"))
+        self.line("    // domain %s" % name)
+        self.walk(name, [], e, [])
+        self.line()
+    
+    def generate(self):
+        for e in self.root:
+            t = tag(e)
+            if t == "enum":
+                self.enum(e)
+            elif t == "bitset":
+                self.bitset(e)
+            elif t == "domain":
+                self.domain(e)
+        self.name_table()
+    
+    # Hash-and-displace perfect hash over register offsets: bucket = mix(k) % B,
+    # slot = mix(k ^ disp[bucket]) % M. Keys are stored to reject misses.
+    def name_table(self):
+        keys = sorted(self.dump)
+        if not keys:
+            return
+        m = max(1, len(keys) * LOAD_NUM // LOAD_DEN)
+        b = max(1, len(keys) // 4)
+        buckets = [[] for _ in range(b)]
+        for k in keys:
+            buckets[mix32(k) % b].append(k)
+        
+        disp = [0] * b
+        slots = [None] * m
+        for bi in sorted(range(b), key=lambda i: -len(buckets[i])):
+            bucket = buckets[bi]
+            if not bucket:
+                continue
+            d = 1
+            while True:
+                pos = [mix32(k ^ d) % m for k in bucket]
+                if len(set(pos)) == len(pos) and all(slots[p] is None for p in pos):
+                    break
+                d += 1
+            disp[bi] = d
+            for k, p in zip(bucket, pos):
+                slots[p] = k
+        
+        self.line("    // offset -> name, %d registers in %d slots" % (len(keys), m))
+        self.line("    const NAME_BUCKETS: usize = %d;" % b)
+        self.line("    const NAME_SLOTS: usize = %d;" % m)
+        self.line("    const NAME_DISP: [u32; NAME_BUCKETS] = [%s];" % ", ".join(str(d) for d in disp))
+        self.line("    const NAME_KEYS: [u32; NAME_SLOTS] = [%s];"
+                  % ", ".join("0x%x" % (k if k is not None else 0xFFFFFFFF) for k in slots))
+        self.line("    const NAME_STRS: [&'static str; NAME_SLOTS] = [%s];"
+                  % ", ".join('"%s"' % (self.dump[k] if k is not None else "") for k in slots))
+        self.line()
+        self.line("    #[inline(always)]")
+        self.line("    const fn mix(mut x: u32) -> u32 {")
+        self.line("        x ^= x >> 16;")
+        self.line("        x = x.wrapping_mul(0x85EB_CA6B);")
+        self.line("        x ^= x >> 13;")
+        self.line("        x = x.wrapping_mul(0xC2B2_AE35);")
+        self.line("        x ^ (x >> 16)")
+        self.line("    }")
+        self.line()
+        self.line("    // Register name for dumps, None for unknown offsets")
+        self.line("    pub fn reg_name(offset: u32) -> Option<&'static str> {")
+        self.line("        let d = NAME_DISP[mix(offset) as usize % NAME_BUCKETS];")
+        self.line("        let slot = mix(offset ^ d) as usize % NAME_SLOTS;")
+        self.line("        if NAME_KEYS[slot] == offset { Some(NAME_STRS[slot]) } else { None }")
+        self.line("    }")
+        
+        # Self-check before anything is written
+        for k in keys:
+            d = disp[mix32(k) % b]
+            assert slots[mix32(k ^ d) % m] == k
+
+
+class Array:
+    def __init__(self, e):
+        self.stride = num(e.get("stride") or "0")
+        self.length = num(e.get("length") or "1")
+        self.offsets = None
+        self.runtime = None
+        if e.get("offsets"):
+            self.offsets = [num(o) for o in e.get("offsets").split(",")]
+            self.offset = 0
+        elif e.get("doffsets"):
+            # Offsets are expressions over the runtime config, e.g. mdp5_cfg->ctl.base[i];
+            # accessors take the resolved base from the caller
+            bases = []
+            for d in e.get("doffsets").split(","):
+                d = re.sub(r"\[\d+\]$", "[i]", d.strip())
+                if d.endswith("[i]") and d not in bases:
+                    bases.append(d)
+            self.runtime = ", ".join(bases) if bases else "runtime base"
+            self.offset = 0
+        else:
+            self.offset = num(e.get("offset") or "0")
+    
+    def base(self, i):
+        if self.offsets:
+            return self.offsets[i] if i < len(self.offsets) else self.offsets[-1]
+        return self.offset + self.stride * i
+    
+    def param(self, n):
+        return "base%d" % n if self.runtime else "i%d" % n
+    
+    def term(self, n):
+        if self.runtime:
+            return "base%d" % n
+        if self.offsets:
+            table = ", ".join("0x%x" % o for o in self.offsets)
+            return "[%s][i%d as usize]" % (table, n)
+        if self.offset:
+            return "(0x%x + 0x%x * i%d)" % (self.offset, self.stride, n)
+        return "0x%x * i%d" % (self.stride, n)
+
+
+def generate(db, path, outdir):
+    module = os.path.splitext(os.path.basename(path))[0]
+    root = db.load(path)
+    em = Emitter(db, root, module)
+    em.generate()
+    
+    with open(path, "rb") as f:
+        digest = hashlib.sha256(f.read()).hexdigest()[:16]
+    
+    text = [
+        "// Generated by scripts/gen_regdb.py from src/%s, do not edit" % os.path.basename(path),
+        "// source %s, %d duplicate variant definitions skipped" % (digest, em.skipped),
+        "",
+        "pub mod %s {" % module,
+    ]
+    text += em.out
+    text += ["}", ""]
+    
+    out = os.path.join(outdir, module + ".seo")
+    with open(out, "w") as f:
+        f.write("\n".join(text))
+    return out, len(em.names), len(em.dump)
+
+
+def main():
+    p = argparse.ArgumentParser(description="Generate register accessors from rules-ng XML")
+    p.add_argument("-o", "--outdir", default="build/gen/regs")
+    p.add_argument("-q", "--quiet", action="store_true")
+    p.add_argument("-M", "--depfile", help="write a Make-style depfile of every XML read")
+    p.add_argument("xml", nargs="+")
+    args = p.parse_args()
+    
+    os.makedirs(args.outdir, exist_ok=True)
+    srcdir = os.path.dirname(os.path.abspath(args.xml[0]))
+    db = Database(srcdir)
+    
+    modules = []
+    for path in args.xml:
+        root = db.load(path)
+        if not any(tag(e) in ("domain", "enum", "bitset") for e in root):
+            continue
+        out, symbols, regs = generate(db, path, args.outdir)
+        modules.append(os.path.splitext(os.path.basename(path))[0])
+        if not args.quiet:
+            print("  GEN     %s (%d symbols, %d named offsets)" % (out, symbols, regs))
+    
+    with open(os.path.join(args.outdir, "mod.seo"), "w") as f:
+        f.write("// Generated by scripts/gen_regdb.py, do not edit\n\n")
+        for m in modules:
+            f.write("pub mod %s;\n" % m)
+    
+    if args.depfile:
+        target = os.path.join(args.outdir, "mod.seo")
+        deps = [os.path.relpath(sys.argv[0])] + [os.path.relpath(p) for p in db.paths]
+        with open(args.depfile, "w") as f:
+            f.write("%s: %s\n" % (target, " \\\n  ".join(deps)))
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
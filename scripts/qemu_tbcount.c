@@ -0,0 +1,109 @@
+// SPDX-License-Identifier: MIT
+/*
+ * QEMU TCG plugin: execution count of every translated block.
+ *
+ * Unlike contrib/plugins/hotblocks, which prints only its top blocks, this
+ * keeps every block that ran, so the branch profile and the executed-page
+ * count built from it cover all of the kernel text the guest touched.
+ *
+ *   -plugin libtbcount.so,out=<file>
+ *
+ * Written when QEMU exits, including on the SIGTERM that ends a timed run.
+ * One line per block: start pc, end pc (exclusive), executions.
+ */
+#include <glib.h>
+#include <inttypes.h>
+#include <stdio.h>
+
+#include <qemu-plugin.h>
+
+QEMU_PLUGIN_EXPORT int qemu_plugin_version = QEMU_PLUGIN_VERSION;
+
+typedef struct {
+    uint64_t start;
+    uint64_t end;
+    uint64_t count;
+} Block;
+
+/* Keyed by start pc: a block retranslated after a flush keeps its count */
+static GHashTable *blocks;
+static GMutex lock;
+static char *out_path;
+
+static void vcpu_tb_exec(unsigned int vcpu_index, void *udata)
+{
+    Block *b = udata;
+
+    __atomic_fetch_add(&b->count, 1, __ATOMIC_RELAXED);
+}
+
+static void vcpu_tb_trans(qemu_plugin_id_t id, struct qemu_plugin_tb *tb)
+{
+    size_t n = qemu_plugin_tb_n_insns(tb);
+    struct qemu_plugin_insn *last = qemu_plugin_tb_get_insn(tb, n - 1);
+    uint64_t start = qemu_plugin_tb_vaddr(tb);
+    uint64_t end = qemu_plugin_insn_vaddr(last) + qemu_plugin_insn_size(last);
+    Block *b;
+
+    g_mutex_lock(&lock);
+    b = g_hash_table_lookup(blocks, &start);
+    if (!b) {
+        b = g_new0(Block, 1);
+        b->start = start;
+        g_hash_table_insert(blocks, &b->start, b);
+    }
+    if (end > b->end) {
+        b->end = end;
+    }
+    g_mutex_unlock(&lock);
+
+    qemu_plugin_register_vcpu_tb_exec_cb(tb, vcpu_tb_exec, QEMU_PLUGIN_CB_NO_REGS, b);
+}
+
+static void plugin_exit(qemu_plugin_id_t id, void *p)
+{
+    GHashTableIter iter;
+    gpointer value;
+    FILE *f = fopen(out_path, "w");
+
+    if (!f) {
+        qemu_plugin_outs("tbcount: cannot open output file\n");
+        return;
+    }
+
+    g_mutex_lock(&lock);
+    g_hash_table_iter_init(&iter, blocks);
+    while (g_hash_table_iter_next(&iter, NULL, &value)) {
+        Block *b = value;
+        uint64_t count = __atomic_load_n(&b->count, __ATOMIC_RELAXED);
+
+        if (count) {
+            fprintf(f, "0x%" PRIx64 " 0x%" PRIx64 " %" PRIu64 "\n", b->start, b->end, count);
+        }
+    }
+    g_mutex_unlock(&lock);
+
+    fclose(f);
+}
+
+QEMU_PLUGIN_EXPORT int qemu_plugin_install(qemu_plugin_id_t id, const qemu_info_t *info,
+                                           int argc, char **argv)
+{
+    for (int i = 0; i < argc; i++) {
+        if (g_str_has_prefix(argv[i], "out=")) {
+            out_path = g_strdup(argv[i] + 4);
+        } else {
+            fprintf(stderr, "tbcount: unknown option %s\n", argv[i]);
+            return -1;
+        }
+    }
+    if (!out_path) {
+        fprintf(stderr, "tbcount: out=<file> is required\n");
+        return -1;
+    }
+
+    blocks = g_hash_table_new(g_int64_hash, g_int64_equal);
+    qemu_plugin_register_vcpu_tb_trans_cb(id, vcpu_tb_trans);
+    qemu_plugin_register_atexit_cb(id, plugin_exit, NULL);
+    return 0;
+}